@@ -11,6 +11,28 @@
 #include <algorithm>
 #include <iomanip>
 #include <cmath>
+#include <unordered_map>
+#include <random>
+#include <limits>
+#include <cctype>
+#include <csignal>
+#include <utility>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <queue>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 using namespace std;
 
@@ -31,6 +53,60 @@ const string STATES[] = {
 
 const int NUM_STATES = 51;
 
+// Electoral votes per state for the 2012-2020 elections (2010 apportionment), same order as STATES
+const int ELECTORAL_VOTES[] = {
+    9, 3, 11, 6, 55,
+    9, 7, 3, 29, 16,
+    4, 4, 20, 11, 6,
+    6, 8, 8, 4, 10,
+    11, 16, 10, 6, 10,
+    3, 5, 6, 4, 14,
+    5, 29, 15, 3, 18,
+    7, 7, 20, 4, 9,
+    3, 11, 38, 6, 3,
+    13, 12, 3, 5, 10,
+    3
+};
+
+const int ELECTORAL_VOTES_TO_WIN = 270;
+
+// Known alternate spellings of candidate names, as (normalized alias, displayed name);
+// every spelling of these candidates is shown with the displayed name
+const pair<string, string> CANDIDATE_ALIASES[] = {
+    {"JOSEPH R BIDEN", "Joe Biden"},
+    {"JOSEPH BIDEN", "Joe Biden"},
+    {"JOSEPH R BIDEN JR", "Joe Biden"},
+    {"DONALD J TRUMP", "Donald Trump"},
+    {"HILLARY RODHAM CLINTON", "Hillary Clinton"},
+    {"BARACK H OBAMA", "Barack Obama"},
+    {"WILLARD MITT ROMNEY", "Mitt Romney"}
+};
+
+// Bootstrap settings for candidate share confidence intervals
+const int BOOTSTRAP_REPLICATES = 1000;
+const unsigned BOOTSTRAP_SEED = 2024;
+
+// Number of county search results shown before asking for the next page
+const int RESULTS_PER_PAGE = 20;
+
+// Query types whose latency is recorded for the statistics report
+enum QueryType { NATIONAL_QUERY, STATE_QUERY, CANDIDATE_QUERY, COUNTY_QUERY, NUM_QUERY_TYPES };
+const string QUERY_NAMES[] = { "National results", "State results", "Candidate results", "County search" };
+
+// Latency histogram buckets: four sub-buckets for each power of two microseconds
+const int LATENCY_SUB_BUCKETS = 4;
+const int LATENCY_BUCKETS = LATENCY_SUB_BUCKETS * 63;
+
+// Hardware events counted by the profiling mode, with their report labels
+const int NUM_PROFILE_COUNTERS = 4;
+const string PROFILE_COUNTER_NAMES[] = { "cycles", "instructions", "cache misses", "branch misses" };
+
+// Set by the --profile option to report counters for each major phase
+bool profilingEnabled = false;
+
+// Set by Ctrl-C while a county search is running, checked by its scan
+volatile sig_atomic_t queryCancelled = 0;
+
 // Class to store a single set of votes
 class Votes{
 private:
@@ -39,19 +115,24 @@ private:
     string candidate;
     string party;
     int voteCount;
+    int countyId; // dense id of the state and county pair, assigned while loading
 
 public:
     // Constructors
-    Votes() : voteCount(0){}
-    Votes(string s, string c, string can, string p, int v) :
-        state(s), county(c), candidate(can), party(p), voteCount(v){}
-
-    // Getters
-    string getState() const { return state; }
-    string getCounty() const { return county; }
-    string getCandidate() const { return candidate; }
-    string getParty() const { return party; }
+    Votes() : voteCount(0), countyId(0){}
+    Votes(string s, string c, string can, string p, int v, int id) :
+        state(move(s)), county(move(c)), candidate(move(can)), party(move(p)), voteCount(v), countyId(id){}
+
+    // Getters, returning references so comparisons don't copy the strings
+    const string& getState() const { return state; }
+    const string& getCounty() const { return county; }
+    const string& getCandidate() const { return candidate; }
+    const string& getParty() const { return party; }
     int getVoteCount() const { return voteCount; }
+    int getCountyId() const { return countyId; }
+
+    // Setters
+    void setCandidate(const string& can) { candidate = can; }
 };
 
 // Class to store candidate summary information
@@ -59,7 +140,7 @@ class CandidateSummary {
     public:
         string name;
         string party;
-        int totalVotes;
+        long long totalVotes;
 
         CandidateSummary(string n, string p) : name(n), party(p), totalVotes(0){}
 
@@ -68,18 +149,137 @@ class CandidateSummary {
         }
 };
 
+// Class to store the two leading candidates in a state or county
+class Contest {
+    public:
+        string winner;
+        string runnerUp;
+        long long winnerVotes;
+        long long runnerUpVotes;
+        long long totalVotes;
+
+        Contest() : winnerVotes(0), runnerUpVotes(0), totalVotes(0){}
+};
+
+// Class to map each raw candidate spelling to one canonical spelling
+class CandidateNames {
+    private:
+        unordered_map<string, string*> resolved; // raw spelling -> displayed spelling
+        unordered_map<string, string> canonical; // normalized key -> displayed spelling
+        bool respelled;                          // a displayed spelling changed after it was handed out
+
+    public:
+        CandidateNames() : respelled(false){}
+
+        const string& resolve(const string& rawName);
+        void applyTo(vector<Votes>& votes);
+};
+
+// Class to record query latencies in log-scale buckets, HDR histogram style,
+// so percentiles stay within 25% of the true value at any magnitude
+class LatencyHistogram {
+    private:
+        vector<long long> counts;
+        long long totalCount;
+        long long maxMicros;
+
+    public:
+        LatencyHistogram() : counts(LATENCY_BUCKETS, 0), totalCount(0), maxMicros(0){}
+
+        void record(long long micros);
+        long long percentile(double p) const;
+        long long getCount() const { return totalCount; }
+        long long getMax() const { return maxMicros; }
+};
+
+LatencyHistogram queryLatencies[NUM_QUERY_TYPES];
+
+// Class to match text against many search terms at once with an Aho-Corasick
+// automaton stored as a flat transition table over the terms' characters
+class CountyMatcher {
+    private:
+        vector<int> alphabetIndex; // character -> table column, 0 for characters in no term
+        int alphabetSize;
+        vector<int> transitions;   // state * alphabetSize + column -> next state
+        vector<bool> accepting;    // a term ends at this state or one of its suffixes
+
+    public:
+        CountyMatcher(const vector<string>& upperTerms);
+
+        bool matches(const string& text) const;
+};
+
+// Class to count hardware events over one phase of work while it is in scope,
+// optionally paused around work that is not part of the phase; does nothing
+// unless profiling is enabled, and reports only wall time where perf counters
+// are unavailable
+class PhaseProfiler {
+    private:
+        string phase;
+        long long rows;
+        int groupFd;                             // leader of the counter group, -1 if none opened
+        int counterFds[NUM_PROFILE_COUNTERS];
+        int counterSlots[NUM_PROFILE_COUNTERS];  // position in the group read, -1 if unavailable
+        int groupSize;
+        bool running;
+        chrono::steady_clock::time_point start;
+        chrono::steady_clock::duration elapsed;
+
+    public:
+        PhaseProfiler(const string& phaseName);
+        ~PhaseProfiler();
+
+        void pause();
+        void resume();
+        void setRows(long long rowCount) { rows = rowCount; }
+};
+
 // Function prototypes
 vector<Votes> readVotesFromFile(const string& filename);
+string readFileContents(const string& filename);
+bool parseVoteRecord(const string& contents, size_t lineStart, size_t lineEnd,
+                     CandidateNames& candidateNames, unordered_map<string, int>& countyIds, vector<Votes>& votes);
+string getCandidateKey(const string& name);
+string normalizeCandidateName(const string& name);
+const string* getAliasedCandidateName(const string& key);
+int getCountyCount(const vector<Votes>& votes);
 void showDataOverview(const vector<Votes>& votes);
 void showNationalResults(const vector<Votes>& votes);
 void showStateResults(const vector<Votes>& votes);
 void showCandidateResults(const vector<Votes>& votes);
 void showCountySearch(const vector<Votes>& votes);
+size_t findNextCountyMatch(const vector<Votes>& votes, const string& countySearch, size_t start);
+size_t findNextCountyMatch(const vector<Votes>& votes, const CountyMatcher& matcher, size_t start);
+vector<string> splitSearchTerms(const string& search);
+void showStateOverview(const vector<Votes>& votes);
+void showScenarioResults(const vector<Votes>& votes);
+void showElectoralResults(const vector<Votes>& votes);
+vector<Contest> getStateContests(const vector<Votes>& votes);
+Contest getContest(const unordered_map<string, long long>& candidateTotals);
+void addToContest(Contest& contest, const string& candidate, long long candidateVotes);
+void showCountyMargins(const vector<Votes>& votes);
+void showQueryStatistics();
+void recordQueryLatency(QueryType type, chrono::steady_clock::time_point start);
+long long findMinimalFlip(const vector<Contest>& contests, const string& winner, const string& challenger,
+                          int electorsNeeded, vector<int>& flippedStates);
 string toUpper(string str);
+bool containsIgnoreCase(const string& text, const string& upperQuery);
+bool equalsIgnoreCase(const string& text, const string& upperQuery);
+void cancelQuery(int signal);
+int getStateIndex(const string& state);
+pair<double, double> bootstrapShareInterval(const vector<pair<long long, long long>>& counties, unsigned seed);
+vector<pair<double, double>> getBootstrapIntervals(const vector<vector<pair<long long, long long>>>& countyResults);
 vector<CandidateSummary> getCandidateSummaries(const vector<Votes>& votes);
+void addToSummaries(vector<CandidateSummary>& summaries, unordered_map<string, size_t>& index, const Votes& vote);
 
 // Main Function
-int main(){
+int main(int argc, char* argv[]){
+    for (int i = 1; i < argc; i++){
+        if (string(argv[i]) == "--profile") {
+            profilingEnabled = true;
+        }
+    }
+
     string filename;
     cout << "Enter file to use: ";
     getline(cin, filename);
@@ -94,10 +294,24 @@ int main(){
         cout << "  4. Candidate results\n";
         cout << "  5. County search\n";
         cout << "  6. Exit\n";
+        cout << "  7. State overview\n";
+        cout << "  8. What-if scenario\n";
+        cout << "  9. Electoral votes\n";
+        cout << " 10. County margins\n";
+        cout << " 11. Query statistics\n";
         cout << "Your choice: ";
 
         int choice;
-        cin >> choice;
+        // a non-numeric line (such as a stray Q left from a county search) is skipped,
+        // and the end of input exits instead of repeating the menu forever
+        if (!(cin >> choice)) {
+            if (cin.eof()) {
+                return 0;
+            }
+            cin.clear();
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            continue;
+        }
         cin.ignore(); // clear newline from input buffer
 
         switch(choice){
@@ -118,30 +332,190 @@ int main(){
                 break;
             case 6:
                 return 0;
+            case 7:
+                showStateOverview(votes);
+                break;
+            case 8:
+                showScenarioResults(votes);
+                break;
+            case 9:
+                showElectoralResults(votes);
+                break;
+            case 10:
+                showCountyMargins(votes);
+                break;
+            case 11:
+                showQueryStatistics();
+                break;
             default:
                 break;
         } 
     }
 }
 
+// SIGINT handler installed while a county search is scanning or printing
+void cancelQuery(int){
+    queryCancelled = 1;
+}
+
+// reads the entire file into memory with one large read
+string readFileContents(const string& filename){
+    ifstream file(filename, ios::ate);
+    string contents;
+    streamoff fileSize = file.tellg();
+    if (fileSize > 0) {
+        contents.resize(fileSize);
+        file.seekg(0);
+        file.read(&contents[0], fileSize);
+        contents.resize(file.gcount());
+    }
+    return contents;
+}
+
+// parses one csv record between lineStart and lineEnd, returns false if incomplete
+bool parseVoteRecord(const string& contents, size_t lineStart, size_t lineEnd,
+                     CandidateNames& candidateNames, unordered_map<string, int>& countyIds, vector<Votes>& votes){
+    // find the field separators first, then build each field from its offsets
+    size_t stateEnd = contents.find(',', lineStart);
+    size_t countyEnd = contents.find(',', stateEnd + 1);
+    size_t candidateEnd = contents.find(',', countyEnd + 1);
+    size_t partyEnd = contents.find(',', candidateEnd + 1);
+    if (stateEnd >= lineEnd || countyEnd >= lineEnd ||
+        candidateEnd >= lineEnd || partyEnd >= lineEnd) {
+        return false;
+    }
+
+    int voteCount = stoi(contents.substr(partyEnd + 1, lineEnd - partyEnd - 1));
+
+    // each state and county pair gets a dense id once here, so reports can group
+    // by county with a vector index instead of hashing names on every query
+    string key = contents.substr(lineStart, countyEnd - lineStart);
+    int countyId = countyIds.emplace(key, (int)countyIds.size()).first->second;
+
+    votes.emplace_back(contents.substr(lineStart, stateEnd - lineStart),
+                       contents.substr(stateEnd + 1, countyEnd - stateEnd - 1),
+                       candidateNames.resolve(contents.substr(countyEnd + 1, candidateEnd - countyEnd - 1)),
+                       contents.substr(candidateEnd + 1, partyEnd - candidateEnd - 1),
+                       voteCount, countyId);
+    return true;
+}
+
+// returns the number of distinct county ids assigned while loading
+int getCountyCount(const vector<Votes>& votes){
+    int count = 0;
+    for (const Votes& vote : votes){
+        count = max(count, vote.getCountyId() + 1);
+    }
+    return count;
+}
+
+// normalizes a candidate name: uppercase, no punctuation, single spaces; bytes
+// outside ASCII are kept as they are so accented names stay distinct
+string normalizeCandidateName(const string& name){
+    string key;
+    for (char c : name){
+        if ((unsigned char)c >= 0x80) {
+            key += c;
+        } else if (isalnum((unsigned char)c)) {
+            key += toupper((unsigned char)c);
+        } else if (isspace((unsigned char)c) && !key.empty() && key.back() != ' ') {
+            key += ' ';
+        }
+    }
+    if (!key.empty() && key.back() == ' ') {
+        key.pop_back();
+    }
+    return key;
+}
+
+// returns the alias table's displayed name for a normalized name that is one of its
+// aliases or its displayed name, or nullptr if the candidate has no aliases
+const string* getAliasedCandidateName(const string& key){
+    for (const auto& alias : CANDIDATE_ALIASES){
+        if (key == alias.first || key == normalizeCandidateName(alias.second)) {
+            return &alias.second;
+        }
+    }
+    return nullptr;
+}
+
+// builds a comparison key for a candidate name, mapping known aliases together;
+// a name with no letters or digits keys on itself so such names are never merged
+string getCandidateKey(const string& name){
+    string key = normalizeCandidateName(name);
+    if (key.empty()) {
+        return name;
+    }
+    const string* aliased = getAliasedCandidateName(key);
+    return aliased ? normalizeCandidateName(*aliased) : key;
+}
+
+// returns the displayed spelling for a raw candidate name; each distinct raw
+// spelling is normalized only once. Candidates in the alias table are shown
+// with the table's name, others with the spelling that sorts first, so the
+// output does not depend on the order of the rows
+const string& CandidateNames::resolve(const string& rawName){
+    auto it = resolved.find(rawName);
+    if (it != resolved.end()) {
+        return *it->second;
+    }
+
+    size_t first = rawName.find_first_not_of(" \t");
+    size_t last = rawName.find_last_not_of(" \t");
+    string trimmed = first == string::npos ? "" : rawName.substr(first, last - first + 1);
+
+    const string* aliased = getAliasedCandidateName(normalizeCandidateName(trimmed));
+    const string& spelling = aliased ? *aliased : trimmed;
+    auto entry = canonical.emplace(getCandidateKey(trimmed), spelling);
+    if (!entry.second && !aliased && spelling < entry.first->second) {
+        entry.first->second = spelling;
+        respelled = true;
+    }
+    return *resolved.emplace(rawName, &entry.first->second).first->second;
+}
+
+// rewrites records loaded before a candidate's displayed spelling changed;
+// does nothing when every candidate was spelled one way
+void CandidateNames::applyTo(vector<Votes>& votes){
+    if (!respelled) {
+        return;
+    }
+    unordered_map<string, const string*> displayed; // spelling handed out -> final spelling
+    for (Votes& vote : votes){
+        auto it = displayed.find(vote.getCandidate());
+        if (it == displayed.end()) {
+            it = displayed.emplace(vote.getCandidate(), &canonical[getCandidateKey(vote.getCandidate())]).first;
+        }
+        if (*it->second != vote.getCandidate()) {
+            vote.setCandidate(*it->second);
+        }
+    }
+}
+
 // reads and parses election data from csv file into vector of vote objects
 vector<Votes> readVotesFromFile(const string& filename){
-    vector<Votes> votes;
-    ifstream file(filename);
-    string state, county, candidate, party, votesStr;
-
-    while(!file.eof()){
-        getline(file, state, ',');
-        if (file.eof()) break;
+    string contents = readFileContents(filename);
+    PhaseProfiler profiler("Parsing");
 
-        getline(file, county, ',');
-        getline(file, candidate, ',');
-        getline(file, party, ',');
-        getline(file, votesStr);
+    // reserve one record per line so the store is allocated once, at its final
+    // size, instead of being regrown and copied while loading
+    vector<Votes> votes;
+    votes.reserve(count(contents.begin(), contents.end(), '\n') + 1);
+    CandidateNames candidateNames;
+    unordered_map<string, int> countyIds;
 
-        int voteCount = stoi(votesStr);
-        votes.emplace_back(state, county, candidate, party, voteCount);
+    size_t lineStart = 0;
+    while(lineStart < contents.size()){
+        size_t lineEnd = contents.find('\n', lineStart);
+        if (lineEnd == string::npos) {
+            lineEnd = contents.size();
+        }
+        parseVoteRecord(contents, lineStart, lineEnd, candidateNames, countyIds, votes); // blank or incomplete lines are skipped
+        lineStart = lineEnd + 1;
     }
+    candidateNames.applyTo(votes);
+
+    profiler.setRows(votes.size());
     return votes;
 }
 
@@ -151,31 +525,460 @@ string toUpper(string str){
     return str;
 }
 
+// 95% bootstrap interval for a state's share, resampling its counties with replacement
+pair<double, double> bootstrapShareInterval(const vector<pair<long long, long long>>& counties, unsigned seed){
+    // seeded per state so the interval does not depend on which states ran before it
+    mt19937 rng(seed);
+    uniform_int_distribution<size_t> pick(0, counties.size() - 1);
+
+    vector<double> shares;
+    shares.reserve(BOOTSTRAP_REPLICATES);
+    for (int r = 0; r < BOOTSTRAP_REPLICATES; r++){
+        long long candidateVotes = 0;
+        long long totalVotes = 0;
+        for (size_t c = 0; c < counties.size(); c++){
+            const pair<long long, long long>& county = counties[pick(rng)];
+            candidateVotes += county.first;
+            totalVotes += county.second;
+        }
+        shares.push_back(totalVotes > 0 ? (100.0 * candidateVotes) / totalVotes : 0.0);
+    }
+
+    sort(shares.begin(), shares.end());
+    return make_pair(shares[BOOTSTRAP_REPLICATES * 25 / 1000],
+                     shares[BOOTSTRAP_REPLICATES * 975 / 1000 - 1]);
+}
+
+// bootstrap intervals for every state with counties, with the states split across
+// worker threads; each state has its own seed, so the results do not depend on
+// the number of threads
+vector<pair<double, double>> getBootstrapIntervals(const vector<vector<pair<long long, long long>>>& countyResults){
+    vector<pair<double, double>> intervals(countyResults.size(), make_pair(0.0, 0.0));
+    auto resampleStates = [&](size_t first, size_t step){
+        for (size_t i = first; i < countyResults.size(); i += step){
+            if (!countyResults[i].empty()) {
+                intervals[i] = bootstrapShareInterval(countyResults[i], BOOTSTRAP_SEED + i);
+            }
+        }
+    };
+
+    // states are dealt out in turn so large and small states mix on every thread
+    size_t threadCount = max<size_t>(1, min<size_t>(thread::hardware_concurrency(), countyResults.size()));
+    vector<thread> workers;
+    for (size_t t = 1; t < threadCount; t++){
+        workers.emplace_back(resampleStates, t, threadCount);
+    }
+    resampleStates(0, threadCount);
+    for (thread& worker : workers){
+        worker.join();
+    }
+    return intervals;
+}
+
+// uppercases one ASCII character without a locale lookup
+inline char toUpperAscii(char c){
+    return (c >= 'a' && c <= 'z') ? c - ('a' - 'A') : c;
+}
+
+// checks the middle of a position whose first and last characters already match
+inline bool matchesMiddle(const char* text, const string& upperQuery){
+    for (size_t i = 1; i + 1 < upperQuery.size(); i++){
+        if (toUpperAscii(text[i]) != upperQuery[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifdef __SSE2__
+// uppercases the ASCII letters in 16 characters at once
+inline __m128i toUpperAscii16(__m128i chars){
+    __m128i isLower = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('a' - 1)),
+                                    _mm_cmplt_epi8(chars, _mm_set1_epi8('z' + 1)));
+    return _mm_sub_epi8(chars, _mm_and_si128(isLower, _mm_set1_epi8('a' - 'A')));
+}
+
+// bit i is set if position i of 16 consecutive start positions has the query's
+// first and last characters, checked for all 16 with two compares
+inline unsigned matchFirstAndLast16(const char* text, size_t length, __m128i first, __m128i last){
+    __m128i firstChars = toUpperAscii16(_mm_loadu_si128((const __m128i*)text));
+    __m128i lastChars = toUpperAscii16(_mm_loadu_si128((const __m128i*)(text + length - 1)));
+    return _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(firstChars, first), _mm_cmpeq_epi8(lastChars, last)));
+}
+#endif
+
+// checks whether text contains an already uppercased query, ignoring case,
+// without building an uppercase copy of the text; the first and last characters
+// rule out most positions before the middle is compared
+bool containsIgnoreCase(const string& text, const string& upperQuery){
+    size_t length = upperQuery.size();
+    if (length == 0) {
+        return true;
+    }
+    if (length > text.size()) {
+        return false;
+    }
+
+    const char* data = text.data();
+    const size_t starts = text.size() - length + 1; // number of positions the query can start at
+    size_t start = 0;
+#ifdef __SSE2__
+    const __m128i firstChars = _mm_set1_epi8(upperQuery[0]);
+    const __m128i lastChars = _mm_set1_epi8(upperQuery[length - 1]);
+    for (; start + 16 <= starts; start += 16){
+        for (unsigned mask = matchFirstAndLast16(data + start, length, firstChars, lastChars); mask != 0; mask &= mask - 1){
+            if (matchesMiddle(data + start + __builtin_ctz(mask), upperQuery)) {
+                return true;
+            }
+        }
+    }
+    // the remaining positions, usually a whole county or candidate name, are copied
+    // into a zero-padded block so they are filtered the same way without reading
+    // past the end of the text
+    if (start < starts && text.size() - start <= 32) {
+        char block[48] = {0};
+        memcpy(block, data + start, text.size() - start);
+        unsigned mask = matchFirstAndLast16(block, length, firstChars, lastChars) & ((1u << (starts - start)) - 1);
+        for (; mask != 0; mask &= mask - 1){
+            if (matchesMiddle(data + start + __builtin_ctz(mask), upperQuery)) {
+                return true;
+            }
+        }
+        return false;
+    }
+#endif
+    const char first = upperQuery[0];
+    const char last = upperQuery[length - 1];
+    for (; start < starts; start++){
+        if (toUpperAscii(data[start]) == first && toUpperAscii(data[start + length - 1]) == last
+                && matchesMiddle(data + start, upperQuery)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// opens the hardware counters as one group, so they all count over the same
+// time window, and starts them when profiling is enabled
+PhaseProfiler::PhaseProfiler(const string& phaseName) :
+    phase(phaseName), rows(0), groupFd(-1), groupSize(0), running(false), elapsed(0){
+    for (int i = 0; i < NUM_PROFILE_COUNTERS; i++){
+        counterFds[i] = -1;
+        counterSlots[i] = -1;
+    }
+    if (!profilingEnabled) {
+        return;
+    }
+#ifdef __linux__
+    const unsigned long long events[NUM_PROFILE_COUNTERS] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
+    for (int i = 0; i < NUM_PROFILE_COUNTERS; i++){
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = events[i];
+        attr.disabled = groupFd == -1 ? 1 : 0; // members follow the leader
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        counterFds[i] = syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0);
+        if (counterFds[i] >= 0) {
+            if (groupFd == -1) {
+                groupFd = counterFds[i];
+            }
+            counterSlots[i] = groupSize++;
+        }
+    }
+    if (groupFd >= 0) {
+        ioctl(groupFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+    resume();
+}
+
+// starts or continues counting for the phase
+void PhaseProfiler::resume(){
+    if (!profilingEnabled || running) {
+        return;
+    }
+    running = true;
+#ifdef __linux__
+    if (groupFd >= 0) {
+        ioctl(groupFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+    start = chrono::steady_clock::now();
+}
+
+// stops counting until the next resume, keeping the totals so far
+void PhaseProfiler::pause(){
+    if (!running) {
+        return;
+    }
+    elapsed += chrono::steady_clock::now() - start;
+#ifdef __linux__
+    if (groupFd >= 0) {
+        ioctl(groupFd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+    running = false;
+}
+
+// stops the counters and prints their totals with IPC and misses per row
+PhaseProfiler::~PhaseProfiler(){
+    if (!profilingEnabled) {
+        return;
+    }
+    pause();
+
+    long long counts[NUM_PROFILE_COUNTERS];
+    for (int i = 0; i < NUM_PROFILE_COUNTERS; i++){
+        counts[i] = -1;
+    }
+    double coverage = 1.0;
+#ifdef __linux__
+    if (groupFd >= 0) {
+        // group read layout: number of counters, time enabled, time running, then the values;
+        // if the PMU was shared the group ran only part of the time, so the counts are scaled up
+        vector<uint64_t> values(3 + groupSize);
+        ssize_t expected = values.size() * sizeof(uint64_t);
+        if (read(groupFd, values.data(), expected) == expected && values[2] > 0) {
+            coverage = (double)values[2] / values[1];
+            for (int i = 0; i < NUM_PROFILE_COUNTERS; i++){
+                if (counterSlots[i] >= 0) {
+                    counts[i] = llround(values[3 + counterSlots[i]] / coverage);
+                }
+            }
+        }
+    }
+    for (int i = 0; i < NUM_PROFILE_COUNTERS; i++){
+        if (counterFds[i] >= 0) {
+            close(counterFds[i]);
+        }
+    }
+#endif
+
+    cerr << "[profile] " << phase << ": "
+         << chrono::duration_cast<chrono::microseconds>(elapsed).count() << " us, "
+         << rows << " rows";
+    for (int i = 0; i < NUM_PROFILE_COUNTERS; i++){
+        if (counts[i] >= 0) {
+            cerr << ", " << counts[i] << " " << PROFILE_COUNTER_NAMES[i];
+        }
+    }
+    if (counts[0] > 0 && counts[1] >= 0) {
+        cerr << ", IPC " << fixed << setprecision(2) << (double)counts[1] / counts[0];
+    }
+    if (rows > 0) {
+        if (counts[2] >= 0) {
+            cerr << ", " << fixed << setprecision(2) << (double)counts[2] / rows << " cache misses/row";
+        }
+        if (counts[3] >= 0) {
+            cerr << ", " << fixed << setprecision(2) << (double)counts[3] / rows << " branch misses/row";
+        }
+    }
+    if (coverage < 1.0) {
+        cerr << " (scaled from " << fixed << setprecision(0) << 100.0 * coverage << "% counter coverage)";
+    }
+    cerr << endl;
+}
+
+// adds a latency sample to the bucket covering its value
+void LatencyHistogram::record(long long micros){
+    int bucket;
+    if (micros < LATENCY_SUB_BUCKETS) {
+        bucket = max(micros, 0LL);
+    } else {
+        int magnitude = 0; // index of the highest set bit
+        while ((micros >> (magnitude + 1)) > 0) {
+            magnitude++;
+        }
+        int subBucket = (micros >> (magnitude - 2)) & (LATENCY_SUB_BUCKETS - 1);
+        bucket = LATENCY_SUB_BUCKETS * (magnitude - 1) + subBucket;
+    }
+    counts[bucket]++;
+    totalCount++;
+    maxMicros = max(maxMicros, micros);
+}
+
+// returns the upper bound of the bucket holding the p-th percentile sample
+long long LatencyHistogram::percentile(double p) const{
+    long long target = (long long)ceil(totalCount * p / 100.0);
+    long long seen = 0;
+    for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++){
+        seen += counts[bucket];
+        if (seen >= max(target, 1LL)) {
+            if (bucket < LATENCY_SUB_BUCKETS) {
+                return bucket;
+            }
+            int magnitude = bucket / LATENCY_SUB_BUCKETS + 1;
+            long long width = 1LL << (magnitude - 2);
+            long long upper = (LATENCY_SUB_BUCKETS + bucket % LATENCY_SUB_BUCKETS) * width + width - 1;
+            return min(upper, maxMicros);
+        }
+    }
+    return maxMicros;
+}
+
+// records the time since start in the histogram for a query type
+void recordQueryLatency(QueryType type, chrono::steady_clock::time_point start){
+    chrono::steady_clock::duration elapsed = chrono::steady_clock::now() - start;
+    queryLatencies[type].record(chrono::duration_cast<chrono::microseconds>(elapsed).count());
+}
+
+// checks whether text equals an already uppercased query, ignoring case
+bool equalsIgnoreCase(const string& text, const string& upperQuery){
+    if (text.size() != upperQuery.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < text.size(); i++){
+        if (toUpperAscii(text[i]) != upperQuery[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// finds a state's position in STATES by binary search, or -1 if unknown
+int getStateIndex(const string& state){
+    const string* it = lower_bound(STATES, STATES + NUM_STATES, state);
+    if (it == STATES + NUM_STATES || *it != state) {
+        return -1;
+    }
+    return it - STATES;
+}
+
+// adds a vote to its candidate's summary, using the name index to find it
+void addToSummaries(vector<CandidateSummary>& summaries, unordered_map<string, size_t>& index, const Votes& vote){
+    auto it = index.find(vote.getCandidate());
+    if (it != index.end()) {
+        summaries[it->second].totalVotes += vote.getVoteCount();
+        return;
+    }
+    index.emplace(vote.getCandidate(), summaries.size());
+    summaries.emplace_back(vote.getCandidate(), vote.getParty());
+    summaries.back().totalVotes = vote.getVoteCount();
+}
+
 // creates summary of total votes for each candidate
 vector<CandidateSummary> getCandidateSummaries(const vector<Votes>& votes){
+    PhaseProfiler profiler("Grouping");
+    profiler.setRows(votes.size());
     vector<CandidateSummary> summaries;
+    unordered_map<string, size_t> index;
 
     for (const Votes& vote : votes){
-        bool found = false;
-        for (CandidateSummary& summary : summaries){
-            if(summary.name == vote.getCandidate()){
-                summary.totalVotes += vote.getVoteCount();
-                found = true;
-                break;
+        addToSummaries(summaries, index, vote);
+    }
+    sort(summaries.begin(), summaries.end());
+    return summaries;
+}
+
+// finds the winner and runner-up of every state in one pass over the records
+vector<Contest> getStateContests(const vector<Votes>& votes){
+    vector<unordered_map<string, long long>> candidateTotals(NUM_STATES);
+    for (const Votes& vote : votes){
+        int i = getStateIndex(vote.getState());
+        if (i >= 0) {
+            candidateTotals[i][vote.getCandidate()] += vote.getVoteCount();
+        }
+    }
+
+    vector<Contest> contests(NUM_STATES);
+    for (int i = 0; i < NUM_STATES; i++){
+        contests[i] = getContest(candidateTotals[i]);
+    }
+    return contests;
+}
+
+// picks the winner and runner-up from per-candidate vote totals
+Contest getContest(const unordered_map<string, long long>& candidateTotals){
+    Contest contest;
+    for (const auto& candidate : candidateTotals){
+        addToContest(contest, candidate.first, candidate.second);
+    }
+    return contest;
+}
+
+// counts one candidate's final total towards a contest, keeping the top two
+void addToContest(Contest& contest, const string& candidate, long long candidateVotes){
+    contest.totalVotes += candidateVotes;
+    if (candidateVotes > contest.winnerVotes){
+        contest.runnerUp = contest.winner;
+        contest.runnerUpVotes = contest.winnerVotes;
+        contest.winner = candidate;
+        contest.winnerVotes = candidateVotes;
+    } else if (candidateVotes > contest.runnerUpVotes){
+        contest.runnerUp = candidate;
+        contest.runnerUpVotes = candidateVotes;
+    }
+}
+
+// knapsack over electoral votes: cheapest set of winner's states whose flip gives the
+// challenger electorsNeeded more electors, returns -1 if no such set exists
+long long findMinimalFlip(const vector<Contest>& contests, const string& winner, const string& challenger,
+                          int electorsNeeded, vector<int>& flippedStates){
+    const long long NO_FLIP = -1;
+    const long long UNREACHABLE = numeric_limits<long long>::max();
+
+    // a state can flip if the winner carried it and the challenger came second;
+    // switching half the margin plus one vote reverses it
+    vector<int> candidates;
+    for (int i = 0; i < NUM_STATES; i++){
+        if (contests[i].winner == winner && contests[i].runnerUp == challenger) {
+            candidates.push_back(i);
+        }
+    }
+
+    // cost[k][e]: fewest votes using the first k candidate states to gain e electors,
+    // where e saturates at electorsNeeded
+    vector<vector<long long>> cost(candidates.size() + 1, vector<long long>(electorsNeeded + 1, UNREACHABLE));
+    cost[0][0] = 0;
+    for (size_t k = 0; k < candidates.size(); k++){
+        int state = candidates[k];
+        long long flipCost = (contests[state].winnerVotes - contests[state].runnerUpVotes) / 2 + 1;
+        for (int e = 0; e <= electorsNeeded; e++){
+            if (cost[k][e] == UNREACHABLE) {
+                continue;
             }
+            cost[k + 1][e] = min(cost[k + 1][e], cost[k][e]);
+            int gained = min(electorsNeeded, e + ELECTORAL_VOTES[state]);
+            cost[k + 1][gained] = min(cost[k + 1][gained], cost[k][e] + flipCost);
         }
-        if(!found){
-            summaries.emplace_back(vote.getCandidate(), vote.getParty());
-            summaries.back().totalVotes = vote.getVoteCount();
+    }
+
+    if (cost[candidates.size()][electorsNeeded] == UNREACHABLE) {
+        return NO_FLIP;
+    }
+
+    // walk back through the table to recover which states were flipped
+    int e = electorsNeeded;
+    for (size_t k = candidates.size(); k > 0; k--){
+        if (cost[k][e] == cost[k - 1][e]) {
+            continue;
+        }
+        int state = candidates[k - 1];
+        long long flipCost = (contests[state].winnerVotes - contests[state].runnerUpVotes) / 2 + 1;
+        for (int prev = 0; prev <= e; prev++){
+            if (cost[k - 1][prev] != UNREACHABLE &&
+                min(electorsNeeded, prev + ELECTORAL_VOTES[state]) == e &&
+                cost[k - 1][prev] + flipCost == cost[k][e]) {
+                flippedStates.push_back(state);
+                e = prev;
+                break;
+            }
         }
     }
-    sort(summaries.begin(), summaries.end());
-    return summaries;
+    reverse(flippedStates.begin(), flippedStates.end());
+    return cost[candidates.size()][electorsNeeded];
 }
 
 // displays total number of records and votes in the dataset
 void showDataOverview(const vector<Votes>& votes) {
-    int totalVotes = 0;
+    long long totalVotes = 0;
     for (const Votes& vote : votes) {
         totalVotes += vote.getVoteCount();
     }
@@ -186,6 +989,7 @@ void showDataOverview(const vector<Votes>& votes) {
 
 // show national vote totals for each candidate, sorted by numer of votes
 void showNationalResults(const vector<Votes>& votes){
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
     vector<CandidateSummary> summaries = getCandidateSummaries(votes);
 
     for(const CandidateSummary& summary : summaries){
@@ -193,6 +997,7 @@ void showNationalResults(const vector<Votes>& votes){
              << left << setw(15) << summary.party
              << right << setw(10) << summary.totalVotes << endl;
     }
+    recordQueryLatency(NATIONAL_QUERY, start);
 }
 
 // Displays graphical bar chart of votes in user-specified state
@@ -201,22 +1006,13 @@ void showStateResults(const vector<Votes>& votes){
     cout << "Enter state: ";
     getline(cin , stateInput);
     string state = toUpper(stateInput);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
 
     vector<CandidateSummary> stateSummaries;
+    unordered_map<string, size_t> index;
     for (const Votes& vote : votes){
         if (vote.getState() == state){
-            bool found = false;
-            for (CandidateSummary& summary : stateSummaries){
-                if (summary.name == vote.getCandidate()){
-                    summary.totalVotes += vote.getVoteCount();
-                    found = true;
-                    break;
-                }
-            }
-            if(!found){
-                stateSummaries.emplace_back(vote.getCandidate(), vote.getParty());
-                stateSummaries.back().totalVotes = vote.getVoteCount();
-            }
+            addToSummaries(stateSummaries, index, vote);
         }
     }
     sort(stateSummaries.begin(), stateSummaries.end());
@@ -226,6 +1022,7 @@ void showStateResults(const vector<Votes>& votes){
         int bars = round(summary.totalVotes / 150000.0);
         cout << string(bars, '|') << endl;
     }
+    recordQueryLatency(STATE_QUERY, start);
 }
 
 // Shows state-by-state results for specified candidate
@@ -234,38 +1031,56 @@ void showCandidateResults(const vector<Votes>& votes) {
     cout << "Enter candidate: ";
     getline(cin, candidateSearch);
     candidateSearch = toUpper(candidateSearch);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
     
     string candidateName;
     for (const Votes& vote : votes) {
-        if (toUpper(vote.getCandidate()).find(candidateSearch) != string::npos) {
+        if (containsIgnoreCase(vote.getCandidate(), candidateSearch)) {
             candidateName = vote.getCandidate();
             break;
         }
     }
     
-    vector<pair<string, pair<int, int>>> stateResults(NUM_STATES);
+    vector<pair<string, pair<long long, long long>>> stateResults(NUM_STATES);
     for (int i = 0; i < NUM_STATES; i++) {
         stateResults[i].first = STATES[i];
         stateResults[i].second.first = 0;  // Candidate votes
         stateResults[i].second.second = 0; // Total votes
     }
     
+    // per-county candidate and total votes, indexed by county id, used for resampling
+    vector<pair<long long, long long>> countyTotals(getCountyCount(votes), make_pair(0LL, 0LL));
+    vector<int> countyStates(countyTotals.size(), -1);
+
     for (const Votes& vote : votes) {
-        for (int i = 0; i < NUM_STATES; i++) {
-            if (vote.getState() == STATES[i]) {
-                if (vote.getCandidate() == candidateName) {
-                    stateResults[i].second.first += vote.getVoteCount();
-                }
-                stateResults[i].second.second += vote.getVoteCount();
-                break;
-            }
+        int i = getStateIndex(vote.getState());
+        if (i < 0) {
+            continue;
+        }
+        pair<long long, long long>& countyResult = countyTotals[vote.getCountyId()];
+        countyStates[vote.getCountyId()] = i;
+
+        if (vote.getCandidate() == candidateName) {
+            stateResults[i].second.first += vote.getVoteCount();
+            countyResult.first += vote.getVoteCount();
+        }
+        stateResults[i].second.second += vote.getVoteCount();
+        countyResult.second += vote.getVoteCount();
+    }
+
+    vector<vector<pair<long long, long long>>> countyResults(NUM_STATES);
+    for (size_t county = 0; county < countyTotals.size(); county++) {
+        if (countyStates[county] >= 0) {
+            countyResults[countyStates[county]].push_back(countyTotals[county]);
         }
     }
     
+    vector<pair<double, double>> intervals = getBootstrapIntervals(countyResults);
     double bestPercentage = 0.0;
     string bestState;
     
-    for (const auto& result : stateResults) {
+    for (int i = 0; i < NUM_STATES; i++) {
+        const auto& result = stateResults[i];
         cout << left << setw(20) << result.first;
         cout << right << setw(10) << result.second.first;
         cout << right << setw(10) << result.second.second;
@@ -279,24 +1094,450 @@ void showCandidateResults(const vector<Votes>& votes) {
             }
         }
         
-        cout << right << setw(7) << fixed << setprecision(1) << percentage << "%" << endl;
+        cout << right << setw(7) << fixed << setprecision(1) << percentage << "%";
+        if (!countyResults[i].empty()) {
+            cout << "  [" << intervals[i].first << "%, " << intervals[i].second << "%]";
+        }
+        cout << endl;
     }
     
     cout << "The best state for " << candidateName << " is " << bestState << endl;
+    recordQueryLatency(CANDIDATE_QUERY, start);
 }
 
 //Displays all voting results for countries matching search term
 void showCountySearch(const vector<Votes>& votes){
     string countySearch;
-    cout << "Enter county: ";
+    cout << "Enter county (separate several with commas): ";
     getline(cin, countySearch);
     countySearch = toUpper(countySearch);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    // a list of counties is compiled into one automaton so the records are scanned once
+    bool multipleTerms = countySearch.find(',') != string::npos;
+    CountyMatcher matcher(multipleTerms ? splitSearchTerms(countySearch) : vector<string>());
+    auto findNext = [&](size_t from){
+        return multipleTerms ? findNextCountyMatch(votes, matcher, from)
+                             : findNextCountyMatch(votes, countySearch, from);
+    };
+
+    // Ctrl-C cancels the search only while it is working; at prompts it exits as before
+    queryCancelled = 0;
+    signal(SIGINT, cancelQuery);
 
-    for(const Votes& vote : votes){
-        if(toUpper(vote.getCounty()).find(countySearch) != string::npos){
-            cout << left << setw(40) << (vote.getCounty() + ", " + vote.getState())
-                 << left << setw(20) << vote.getCandidate()
-                 << right << setw(10) << vote.getVoteCount() << endl;
+    // matches are found one page at a time, so nothing past the current page is scanned;
+    // the recorded latency is the time to the first page, not time spent paging.
+    // The profiler runs only during the scans, not while printing or waiting at the prompt
+    PhaseProfiler profiler("Matching");
+    size_t next = findNext(0);
+    profiler.pause();
+    int shownOnPage = 0;
+    bool recorded = false;
+    while(next < votes.size() && !queryCancelled){
+        if (shownOnPage == RESULTS_PER_PAGE) {
+            if (!recorded) {
+                recordQueryLatency(COUNTY_QUERY, start);
+                recorded = true;
+            }
+            string answer;
+            cout << "-- Press Enter for more, or Q to stop: ";
+            signal(SIGINT, SIG_DFL);
+            getline(cin, answer);
+            signal(SIGINT, cancelQuery);
+            if (toUpper(answer) == "Q") {
+                break;
+            }
+            shownOnPage = 0;
         }
+
+        const Votes& vote = votes[next];
+        cout << left << setw(40) << (vote.getCounty() + ", " + vote.getState())
+             << left << setw(20) << vote.getCandidate()
+             << right << setw(10) << vote.getVoteCount() << endl;
+        shownOnPage++;
+        profiler.resume();
+        next = findNext(next + 1);
+        profiler.pause();
+    }
+    signal(SIGINT, SIG_DFL);
+    if (queryCancelled) {
+        cout << "Search cancelled" << endl;
     }
-}
\ No newline at end of file
+    if (!recorded) {
+        recordQueryLatency(COUNTY_QUERY, start);
+    }
+    profiler.setRows(next); // records scanned before the search ended
+}
+
+// returns the index of the next record from start whose county matches,
+// or votes.size() if there is none or the search was cancelled
+size_t findNextCountyMatch(const vector<Votes>& votes, const string& countySearch, size_t start){
+    for (size_t i = start; i < votes.size() && !queryCancelled; i++){
+        if (containsIgnoreCase(votes[i].getCounty(), countySearch)) {
+            return i;
+        }
+    }
+    return votes.size();
+}
+
+// returns the index of the next record from start whose county matches any term,
+// or votes.size() if there is none or the search was cancelled
+size_t findNextCountyMatch(const vector<Votes>& votes, const CountyMatcher& matcher, size_t start){
+    for (size_t i = start; i < votes.size() && !queryCancelled; i++){
+        if (matcher.matches(votes[i].getCounty())) {
+            return i;
+        }
+    }
+    return votes.size();
+}
+
+// splits a comma separated search into trimmed, non-empty terms
+vector<string> splitSearchTerms(const string& search){
+    vector<string> terms;
+    size_t termStart = 0;
+    while (termStart <= search.size()){
+        size_t termEnd = search.find(',', termStart);
+        if (termEnd == string::npos) {
+            termEnd = search.size();
+        }
+        size_t first = search.find_first_not_of(" \t", termStart);
+        size_t last = search.find_last_not_of(" \t", termEnd - 1);
+        if (first < termEnd && last != string::npos && last >= first) {
+            terms.push_back(search.substr(first, last - first + 1));
+        }
+        termStart = termEnd + 1;
+    }
+    return terms;
+}
+
+// builds the trie of all terms, then fills in failure transitions breadth first
+// so every state has a direct transition for every column
+CountyMatcher::CountyMatcher(const vector<string>& upperTerms) : alphabetIndex(256, 0), alphabetSize(1){
+    for (const string& term : upperTerms){
+        for (char c : term){
+            int& column = alphabetIndex[(unsigned char)c];
+            if (column == 0) {
+                column = alphabetSize++;
+            }
+        }
+    }
+
+    transitions.assign(alphabetSize, -1);
+    accepting.assign(1, false);
+    for (const string& term : upperTerms){
+        int state = 0;
+        for (char c : term){
+            int& next = transitions[state * alphabetSize + alphabetIndex[(unsigned char)c]];
+            if (next == -1) {
+                next = accepting.size();
+                accepting.push_back(false);
+                transitions.resize(transitions.size() + alphabetSize, -1);
+            }
+            state = transitions[state * alphabetSize + alphabetIndex[(unsigned char)c]];
+        }
+        accepting[state] = true;
+    }
+
+    vector<int> failure(accepting.size(), 0);
+    queue<int> pending;
+    for (int column = 0; column < alphabetSize; column++){
+        int& next = transitions[column];
+        if (next == -1) {
+            next = 0;
+        } else {
+            pending.push(next);
+        }
+    }
+    while (!pending.empty()){
+        int state = pending.front();
+        pending.pop();
+        if (accepting[failure[state]]) {
+            accepting[state] = true;
+        }
+        for (int column = 0; column < alphabetSize; column++){
+            int& next = transitions[state * alphabetSize + column];
+            int fallback = transitions[failure[state] * alphabetSize + column];
+            if (next == -1) {
+                next = fallback;
+            } else {
+                failure[next] = fallback;
+                pending.push(next);
+            }
+        }
+    }
+}
+
+// runs the text through the automaton, stopping at the first term found
+bool CountyMatcher::matches(const string& text) const{
+    int state = 0;
+    if (accepting[state]) {
+        return true;
+    }
+    for (char c : text){
+        state = transitions[state * alphabetSize + alphabetIndex[(unsigned char)toUpperAscii(c)]];
+        if (accepting[state]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Shows each state's share of all votes cast and its leading party share as a heatmap table
+void showStateOverview(const vector<Votes>& votes){
+    vector<long long> stateTotals(NUM_STATES, 0);
+    vector<unordered_map<string, long long>> partyTotals(NUM_STATES);
+    long long nationalTotal = 0;
+
+    // single pass over the records fills every state's totals at once
+    for (const Votes& vote : votes){
+        int i = getStateIndex(vote.getState());
+        if (i < 0) {
+            continue;
+        }
+        stateTotals[i] += vote.getVoteCount();
+        partyTotals[i][vote.getParty()] += vote.getVoteCount();
+        nationalTotal += vote.getVoteCount();
+    }
+
+    // the first share is the state's part of the national vote, the second is the
+    // leading party's part of the state's vote
+    cout << left << setw(20) << "State"
+         << right << setw(10) << "Votes"
+         << right << setw(8) << "% of US" << "  "
+         << left << setw(15) << "Leading party"
+         << right << setw(7) << "Lead %" << " "
+         << "Heat" << endl;
+    for (int i = 0; i < NUM_STATES; i++){
+        string leadingParty;
+        long long leadingVotes = 0;
+        for (const auto& party : partyTotals[i]){
+            if (party.second > leadingVotes){
+                leadingParty = party.first;
+                leadingVotes = party.second;
+            }
+        }
+
+        double nationalShare = 0.0;
+        double leadingShare = 0.0;
+        if (stateTotals[i] > 0){
+            nationalShare = (100.0 * stateTotals[i]) / nationalTotal;
+            leadingShare = (100.0 * leadingVotes) / stateTotals[i];
+        }
+
+        // one heat character per 5% of leading share, darker as that share grows
+        int cells = round(leadingShare / 5.0);
+        char shade = leadingShare >= 60.0 ? '#' : (leadingShare >= 50.0 ? '+' : '.');
+
+        cout << left << setw(20) << STATES[i]
+             << right << setw(10) << stateTotals[i]
+             << right << setw(7) << fixed << setprecision(1) << nationalShare << "%  "
+             << left << setw(15) << leadingParty
+             << right << setw(6) << leadingShare << "% "
+             << string(cells, shade) << endl;
+    }
+}
+
+// Applies a percent vote change to one party and shows the adjusted national results
+void showScenarioResults(const vector<Votes>& votes){
+    string stateInput, partyInput;
+    cout << "Enter state (blank for all states): ";
+    getline(cin, stateInput);
+    cout << "Enter party: ";
+    getline(cin, partyInput);
+    double percentChange;
+    cout << "Enter percent change in votes: ";
+    if (!(cin >> percentChange)) {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "Percent change must be a number" << endl;
+        return;
+    }
+    cin.ignore(); // clear newline from input buffer
+
+    string state = toUpper(stateInput);
+    string party = toUpper(partyInput);
+
+    vector<CandidateSummary> summaries;
+    unordered_map<string, size_t> index;
+    for (const Votes& vote : votes){
+        addToSummaries(summaries, index, vote);
+    }
+
+    // the change is kept as a delta per candidate so the base totals are never copied;
+    // it is summed unrounded and rounded once per candidate
+    vector<double> exactDeltas(summaries.size(), 0.0);
+    for (const Votes& vote : votes){
+        if ((state.empty() || vote.getState() == state) && equalsIgnoreCase(vote.getParty(), party)){
+            exactDeltas[index[vote.getCandidate()]] += vote.getVoteCount() * percentChange / 100.0;
+        }
+    }
+    vector<long long> deltas(summaries.size());
+    for (size_t i = 0; i < deltas.size(); i++){
+        deltas[i] = llround(exactDeltas[i]);
+    }
+
+    vector<size_t> order(summaries.size());
+    for (size_t i = 0; i < order.size(); i++){
+        order[i] = i;
+    }
+    sort(order.begin(), order.end(), [&](size_t a, size_t b){
+        return summaries[a].totalVotes + deltas[a] > summaries[b].totalVotes + deltas[b];
+    });
+
+    for (size_t i : order){
+        cout << left << setw(20) << summaries[i].name
+             << left << setw(15) << summaries[i].party
+             << right << setw(10) << summaries[i].totalVotes
+             << right << setw(10) << summaries[i].totalVotes + deltas[i]
+             << right << setw(10) << showpos << deltas[i] << noshowpos << endl;
+    }
+}
+
+// Shows electoral votes won by each candidate, awarding each state to its winner
+void showElectoralResults(const vector<Votes>& votes){
+    vector<Contest> contests = getStateContests(votes);
+
+    // Maine and Nebraska split electors by congressional district, but the data
+    // only has county rows, so their electors go to the statewide winner as well
+    vector<pair<string, int>> electoralTotals;
+    for (int i = 0; i < NUM_STATES; i++){
+        if (contests[i].winner.empty()) {
+            continue;
+        }
+        auto it = find_if(electoralTotals.begin(), electoralTotals.end(),
+                          [&](const pair<string, int>& total){ return total.first == contests[i].winner; });
+        if (it == electoralTotals.end()) {
+            electoralTotals.emplace_back(contests[i].winner, ELECTORAL_VOTES[i]);
+        } else {
+            it->second += ELECTORAL_VOTES[i];
+        }
+    }
+    sort(electoralTotals.begin(), electoralTotals.end(),
+         [](const pair<string, int>& a, const pair<string, int>& b){ return a.second > b.second; });
+
+    for (const auto& total : electoralTotals){
+        cout << left << setw(20) << total.first
+             << right << setw(5) << total.second << endl;
+    }
+
+    if (!electoralTotals.empty() && electoralTotals[0].second >= ELECTORAL_VOTES_TO_WIN) {
+        cout << electoralTotals[0].first << " wins the electoral college" << endl;
+
+        if (electoralTotals.size() > 1) {
+            const string& winner = electoralTotals[0].first;
+            const string& challenger = electoralTotals[1].first;
+            vector<int> flippedStates;
+            long long flipVotes = findMinimalFlip(contests, winner, challenger,
+                                                  ELECTORAL_VOTES_TO_WIN - electoralTotals[1].second, flippedStates);
+            if (flipVotes < 0) {
+                cout << "No set of state flips gives " << challenger << " the election" << endl;
+            } else {
+                cout << "Fewest votes to flip the outcome: " << flipVotes << " switched from "
+                     << winner << " to " << challenger << " in:" << endl;
+                for (int i : flippedStates){
+                    cout << "  " << left << setw(20) << STATES[i]
+                         << right << setw(10) << contests[i].winnerVotes - contests[i].runnerUpVotes << " margin, "
+                         << ELECTORAL_VOTES[i] << " electors" << endl;
+                }
+            }
+        }
+    } else {
+        cout << "No candidate reaches " << ELECTORAL_VOTES_TO_WIN << " electoral votes" << endl;
+    }
+}
+
+// Shows the counties with the closest or widest winning margins, nationwide or in one state
+void showCountyMargins(const vector<Votes>& votes){
+    string stateInput, orderInput;
+    cout << "Enter state (blank for all states): ";
+    getline(cin, stateInput);
+    cout << "Closest or widest margins (C/W): ";
+    getline(cin, orderInput);
+    int count;
+    cout << "Number of counties: ";
+    if (!(cin >> count)) {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "Number of counties must be a whole number" << endl;
+        return;
+    }
+    cin.ignore(); // clear newline from input buffer
+
+    string state = toUpper(stateInput);
+    bool widest = toUpper(orderInput) == "W";
+
+    // group candidate totals by county id in a single pass; a county has only a few
+    // candidates, so each keeps a short list pointing at the records' names
+    vector<const Votes*> countyRecords(getCountyCount(votes), nullptr);
+    vector<vector<pair<const string*, long long>>> candidateTotals(countyRecords.size());
+    for (const Votes& vote : votes){
+        if (!state.empty() && vote.getState() != state) {
+            continue;
+        }
+        int county = vote.getCountyId();
+        if (countyRecords[county] == nullptr) {
+            countyRecords[county] = &vote;
+            candidateTotals[county].reserve(4); // room for the usual handful of candidates
+        }
+        vector<pair<const string*, long long>>& totals = candidateTotals[county];
+        auto it = find_if(totals.begin(), totals.end(),
+                          [&](const pair<const string*, long long>& total){ return *total.first == vote.getCandidate(); });
+        if (it == totals.end()) {
+            totals.emplace_back(&vote.getCandidate(), vote.getVoteCount());
+        } else {
+            it->second += vote.getVoteCount();
+        }
+    }
+
+    vector<pair<double, size_t>> margins;
+    vector<Contest> contests(countyRecords.size());
+    for (size_t i = 0; i < countyRecords.size(); i++){
+        if (countyRecords[i] == nullptr) {
+            continue;
+        }
+        Contest& contest = contests[i];
+        for (const auto& total : candidateTotals[i]){
+            addToContest(contest, *total.first, total.second);
+        }
+        double margin = 0.0;
+        if (contest.totalVotes > 0) {
+            margin = (100.0 * (contest.winnerVotes - contest.runnerUpVotes)) / contest.totalVotes;
+        }
+        margins.emplace_back(margin, i);
+    }
+
+    // only the requested number of counties needs to be in order
+    size_t shown = min(margins.size(), (size_t)max(count, 0));
+    partial_sort(margins.begin(), margins.begin() + shown, margins.end(),
+                 [widest](const pair<double, size_t>& a, const pair<double, size_t>& b){
+                     return widest ? a.first > b.first : a.first < b.first;
+                 });
+
+    for (size_t i = 0; i < shown; i++){
+        const Votes& county = *countyRecords[margins[i].second];
+        const Contest& contest = contests[margins[i].second];
+        cout << left << setw(40) << (county.getCounty() + ", " + county.getState())
+             << left << setw(20) << contest.winner
+             << left << setw(20) << contest.runnerUp
+             << right << setw(7) << fixed << setprecision(1) << margins[i].first << "%" << endl;
+    }
+}
+
+// Shows latency percentiles in microseconds for each query type run this session
+void showQueryStatistics(){
+    cout << left << setw(20) << "Query"
+         << right << setw(8) << "Count"
+         << right << setw(10) << "p50 us"
+         << right << setw(10) << "p90 us"
+         << right << setw(10) << "p99 us"
+         << right << setw(10) << "Max us" << endl;
+    for (int type = 0; type < NUM_QUERY_TYPES; type++){
+        const LatencyHistogram& histogram = queryLatencies[type];
+        cout << left << setw(20) << QUERY_NAMES[type]
+             << right << setw(8) << histogram.getCount()
+             << right << setw(10) << histogram.percentile(50)
+             << right << setw(10) << histogram.percentile(90)
+             << right << setw(10) << histogram.percentile(99)
+             << right << setw(10) << histogram.getMax() << endl;
+    }
+}
@@ -0,0 +1,144 @@
+// Allocation check for the query paths: counts heap allocations made by each
+// report on a warmed-up store and fails if a query allocates per record.
+//
+// Each query runs on two synthetic stores with the same states and counties,
+// the second holding every record twice. A query that allocates for each
+// record it scans makes more allocations on the larger store.
+//
+// Build and run from the repository root:
+//   g++ -std=c++11 -O2 -pthread -o allocation_check tests/allocation_check.cpp
+//   ./allocation_check
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+
+static std::atomic<long long> allocationCount(0);
+
+// GCC pairs the inlined free below with its own idea of operator new and warns
+// about a mismatch; these hooks replace both, so the pairing is correct
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size){
+    allocationCount++;
+    void* memory = std::malloc(size ? size : 1);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+#define main presidentialElectionMain
+#include "../presidentialElection.cpp"
+#undef main
+
+// Discards report output without allocating, so only the query itself is counted
+class NullBuffer : public streambuf {
+    protected:
+        int overflow(int c) { return c; }
+};
+
+// A query to check: the report function and the menu input it reads
+struct QueryCheck {
+    const char* name;
+    void (*run)(const vector<Votes>&);
+    const char* input;
+};
+
+// builds a store of 20 counties per state with three candidates each, every
+// record repeated copies times, through the same parser as the loader; names
+// are too long for the short-string buffer, so a copy of one always allocates
+vector<Votes> buildStore(int copies){
+    const char* CANDIDATES[] = {
+        "Joseph Robinette Biden,Democratic", "Donald John Trump,Republican", "Jo Jorgensen Libertarian,Libertarian"
+    };
+    string contents;
+    for (int state = 0; state < NUM_STATES; state++){
+        for (int county = 0; county < 20; county++){
+            for (int candidate = 0; candidate < 3; candidate++){
+                for (int copy = 0; copy < copies; copy++){
+                    contents += STATES[state] + ",Synthetic County " + to_string(county) + "," + CANDIDATES[candidate] + ","
+                              + to_string(1000 + (state * 37 + county * 11 + candidate * 503) % 4000) + "\n";
+                }
+            }
+        }
+    }
+
+    vector<Votes> votes;
+    CandidateNames candidateNames;
+    unordered_map<string, int> countyIds;
+    size_t lineStart = 0;
+    while (lineStart < contents.size()){
+        size_t lineEnd = contents.find('\n', lineStart);
+        parseVoteRecord(contents, lineStart, lineEnd, candidateNames, countyIds, votes);
+        lineStart = lineEnd + 1;
+    }
+    candidateNames.applyTo(votes);
+    return votes;
+}
+
+// runs a query with the given menu input and returns the allocations it made
+long long countAllocations(const QueryCheck& query, const vector<Votes>& votes){
+    istringstream input(query.input);
+    streambuf* oldInput = cin.rdbuf(input.rdbuf());
+    long long before = allocationCount;
+    query.run(votes);
+    long long allocations = allocationCount - before;
+    cin.rdbuf(oldInput);
+    return allocations;
+}
+
+int main(){
+    const QueryCheck QUERIES[] = {
+        {"Data overview", showDataOverview, ""},
+        {"National results", showNationalResults, ""},
+        {"State results", showStateResults, "ohio\n"},
+        {"Candidate results", showCandidateResults, "biden\n"},
+        {"County search", showCountySearch, "no such county\n"},
+        {"County list search", showCountySearch, "no such county, nor this one\n"},
+        {"State overview", showStateOverview, ""},
+        {"What-if scenario", showScenarioResults, "\nrepublican\n-5\n"},
+        {"Electoral votes", showElectoralResults, ""},
+        {"County margins", showCountyMargins, "\nc\n10\n"}
+    };
+
+    vector<Votes> smallStore = buildStore(1);
+    vector<Votes> largeStore = buildStore(2);
+
+    NullBuffer nullBuffer;
+    streambuf* oldOutput = cout.rdbuf(&nullBuffer);
+    vector<pair<long long, long long>> counts;
+    for (const QueryCheck& query : QUERIES){
+        countAllocations(query, smallStore); // warm-up run
+        long long small = countAllocations(query, smallStore);
+        long long large = countAllocations(query, largeStore);
+        counts.push_back(make_pair(small, large));
+    }
+    cout.rdbuf(oldOutput);
+
+    bool passed = true;
+    cout << left << setw(20) << "Query"
+         << right << setw(12) << smallStore.size() << " rows"
+         << right << setw(12) << largeStore.size() << " rows" << endl;
+    for (size_t i = 0; i < counts.size(); i++){
+        bool perRecord = counts[i].second != counts[i].first;
+        passed = passed && !perRecord;
+        cout << left << setw(20) << QUERIES[i].name
+             << right << setw(17) << counts[i].first
+             << right << setw(17) << counts[i].second
+             << (perRecord ? "  allocates per record" : "") << endl;
+    }
+    cout << (passed ? "PASS" : "FAIL") << endl;
+    return passed ? 0 : 1;
+}